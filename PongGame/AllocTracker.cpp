@@ -0,0 +1,89 @@
+#include "AllocTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace std;
+
+static atomic<unsigned> g_counts[AllocSubsystemCount];
+static atomic<size_t> g_bytes[AllocSubsystemCount];
+static thread_local AllocSubsystem g_subsystem = AllocWorkers;
+
+static const char* const SUBSYSTEM_NAMES[AllocSubsystemCount] = {
+    "other", "events", "update", "draw", "display", "workers"
+};
+
+void AllocTracker::setGameThread() {
+    g_subsystem = AllocOther;
+}
+
+void AllocTracker::beginFrame() {
+    for (int i = 0; i < AllocSubsystemCount; i++) {
+        g_counts[i].store(0, memory_order_relaxed);
+        g_bytes[i].store(0, memory_order_relaxed);
+    }
+}
+
+AllocStats AllocTracker::frameStats() {
+    AllocStats stats;
+    for (int i = 0; i < AllocSubsystemCount; i++) {
+        stats.count[i] = g_counts[i].load(memory_order_relaxed);
+        stats.bytes[i] = g_bytes[i].load(memory_order_relaxed);
+    }
+    return stats;
+}
+
+unsigned AllocTracker::endFrame(bool enforce) {
+    AllocStats stats = frameStats();
+    unsigned total = stats.totalCount();
+
+    // Worker threads are reported on their own so a report points at the
+    // right code.
+    if (enforce && total > 0) {
+        cerr << "Heap allocations during match frame:";
+        if (total > stats.count[AllocWorkers]) {
+            cerr << " game thread";
+            for (int i = 0; i < AllocWorkers; i++) {
+                if (stats.count[i] > 0) {
+                    cerr << ' ' << SUBSYSTEM_NAMES[i] << '=' << stats.count[i]
+                        << " (" << stats.bytes[i] << " bytes)";
+                }
+            }
+        }
+        if (stats.count[AllocWorkers] > 0) {
+            cerr << (total > stats.count[AllocWorkers] ? ";" : "") << " worker threads="
+                << stats.count[AllocWorkers] << " (" << stats.bytes[AllocWorkers] << " bytes)";
+        }
+        cerr << endl;
+    }
+    return total;
+}
+
+AllocSubsystem AllocTracker::subsystem() {
+    return g_subsystem;
+}
+
+void AllocTracker::setSubsystem(AllocSubsystem subsystem) {
+    g_subsystem = subsystem;
+}
+
+void* operator new(size_t size) {
+    g_counts[g_subsystem].fetch_add(1, memory_order_relaxed);
+    g_bytes[g_subsystem].fetch_add(size, memory_order_relaxed);
+
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts heap allocations per frame, split by the subsystem that was
+// running when they happened. Threads other than the game thread are
+// counted together under AllocWorkers until they tag themselves. The
+// global operator new/delete replacements live in AllocTracker.cpp.
+
+enum AllocSubsystem {
+    AllocOther, AllocEvents, AllocUpdate, AllocDraw, AllocDisplay,   // game thread
+    AllocWorkers,                                                     // every other thread
+    AllocSubsystemCount
+};
+
+struct AllocStats {
+    unsigned count[AllocSubsystemCount];
+    size_t bytes[AllocSubsystemCount];
+
+    unsigned totalCount() const {
+        unsigned total = 0;
+        for (int i = 0; i < AllocSubsystemCount; i++) {
+            total += count[i];
+        }
+        return total;
+    }
+};
+
+class AllocTracker {
+public:
+    // Call once from the game thread before the first frame.
+    static void setGameThread();
+
+    static void beginFrame();
+    static AllocStats frameStats();
+
+    // Ends the frame and, when enforce is set, reports any allocation
+    // that happened during it. Returns the number of allocations.
+    static unsigned endFrame(bool enforce);
+
+    static AllocSubsystem subsystem();
+    static void setSubsystem(AllocSubsystem subsystem);
+};
+
+// Attributes allocations on this thread to a subsystem for its lifetime.
+class AllocScope {
+private:
+    AllocSubsystem m_previous;
+
+public:
+    AllocScope(AllocSubsystem subsystem) : m_previous(AllocTracker::subsystem()) {
+        AllocTracker::setSubsystem(subsystem);
+    }
+
+    ~AllocScope() {
+        AllocTracker::setSubsystem(m_previous);
+    }
+};
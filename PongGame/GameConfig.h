@@ -0,0 +1,147 @@
+#pragma once
+
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+class GameConfig {
+public:
+    float courtWidth = 800, courtHeight = 600;
+    float paddleSpeed = 5, botSpeed = 2;
+    float serveSpeedX = 3, serveSpeedY = 3;
+    int winScore = 10;
+    int leaderboardSize = 10;
+    bool pipelineTicks = false;
+
+    // Reads "key value" lines; unknown keys and bad lines are skipped.
+    bool loadFromFile(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream iss(line);
+            std::string key;
+            float value;
+
+            if (!(iss >> key >> value) || key[0] == '#') {
+                continue;
+            }
+
+            if (key == "courtWidth") courtWidth = value;
+            else if (key == "courtHeight") courtHeight = value;
+            else if (key == "paddleSpeed") paddleSpeed = value;
+            else if (key == "botSpeed") botSpeed = value;
+            else if (key == "serveSpeedX") serveSpeedX = value;
+            else if (key == "serveSpeedY") serveSpeedY = value;
+            else if (key == "winScore") winScore = static_cast<int>(value);
+            else if (key == "leaderboardSize") leaderboardSize = static_cast<int>(value);
+            else if (key == "pipelineTicks") pipelineTicks = value != 0;
+            else std::cerr << "Unknown config key: " << key << std::endl;
+        }
+        return true;
+    }
+
+    // Logs every value outside the range the game can play with. The menus
+    // and text are laid out for an 800x600 window, so the court can only be
+    // larger, and serves faster than the ball is wide can pass straight
+    // through a paddle between ticks.
+    bool validate() const {
+        bool valid = true;
+        valid &= checkRange("courtWidth", courtWidth, 800, 4000);
+        valid &= checkRange("courtHeight", courtHeight, 600, 4000);
+        valid &= checkRange("paddleSpeed", paddleSpeed, 0.5f, 50);
+        valid &= checkRange("botSpeed", botSpeed, 0.5f, 50);
+        valid &= checkRange("serveSpeedX", serveSpeedX, 0.5f, 20);
+        valid &= checkRange("serveSpeedY", serveSpeedY, 0, 20);
+        valid &= checkRange("winScore", static_cast<float>(winScore), 1, 99);
+        valid &= checkRange("leaderboardSize", static_cast<float>(leaderboardSize), 1, 100);
+        return valid;
+    }
+
+private:
+    static bool checkRange(const char* key, float value, float low, float high) {
+        if (value >= low && value <= high) {
+            return true;
+        }
+        std::cerr << "Config value " << key << " " << value << " outside ["
+            << low << ", " << high << "]" << std::endl;
+        return false;
+    }
+};
+
+// Owns the current config snapshot and swaps in a new one when the file
+// changes on disk. Snapshots are immutable, so the game keeps reading
+// through a plain pointer and only poll() ever touches the file system.
+class ConfigWatcher {
+private:
+    std::string m_path;
+    std::shared_ptr<const GameConfig> m_current;
+    std::time_t m_lastModified;
+    int m_framesUntilCheck;
+
+    static const int CHECK_INTERVAL = 60;
+
+    std::time_t modifiedTime() const {
+        struct stat info;
+        return stat(m_path.c_str(), &info) == 0 ? info.st_mtime : 0;
+    }
+
+public:
+    ConfigWatcher(const std::string& path)
+        : m_path(path), m_lastModified(0), m_framesUntilCheck(CHECK_INTERVAL) {
+        auto config = std::make_shared<GameConfig>();
+        if (!config->loadFromFile(m_path)) {
+            std::cerr << "Failed to load " << m_path << ", using defaults" << std::endl;
+        }
+        else if (!config->validate()) {
+            std::cerr << "Invalid " << m_path << ", using defaults" << std::endl;
+            *config = GameConfig();
+        }
+        m_current = config;
+        m_lastModified = modifiedTime();
+    }
+
+    const GameConfig& get() const { return *m_current; }
+    std::shared_ptr<const GameConfig> snapshot() const { return m_current; }
+
+    // Call between ticks. Returns true when a new snapshot was published.
+    bool poll() {
+        if (--m_framesUntilCheck > 0) {
+            return false;
+        }
+        m_framesUntilCheck = CHECK_INTERVAL;
+
+        std::time_t modified = modifiedTime();
+        if (modified == m_lastModified) {
+            return false;
+        }
+        m_lastModified = modified;
+
+        auto config = std::make_shared<GameConfig>();
+        if (!config->loadFromFile(m_path)) {
+            return false;
+        }
+
+        // The window and leaderboard are sized once at startup.
+        config->courtWidth = m_current->courtWidth;
+        config->courtHeight = m_current->courtHeight;
+        config->leaderboardSize = m_current->leaderboardSize;
+
+        // A bad edit must not reach a match in progress.
+        if (!config->validate()) {
+            std::cerr << "Ignoring invalid " << m_path << std::endl;
+            return false;
+        }
+
+        m_current = config;
+        std::cerr << "Reloaded " << m_path << std::endl;
+        return true;
+    }
+};
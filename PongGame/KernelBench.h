@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+#include "PongRules.h"
+
+// Times the mode-specialized kernels against the runtime-dispatch
+// overload, which is what callers use when the mode is a variable. Run as
+// "PongGame --bench [ticks]".
+//
+// Both paddles track the ball so rallies run long, and the ball is served
+// as soon as a point ends. The mode is read through a volatile each tick
+// so the compiler cannot hoist the dispatch out of the loop.
+
+struct KernelBenchResult {
+    double nanosPerTick;
+    unsigned long long checksum;  // keeps the loop from being optimized away
+};
+
+inline void benchInput(const MatchState& s, MatchInput& in) {
+    float ball = s.ballY + BALL_RADIUS;
+    in.p1Up = ball < s.p1Y + PADDLE_HEIGHT / 2 - BOT_DEAD_ZONE;
+    in.p1Down = ball > s.p1Y + PADDLE_HEIGHT / 2 + BOT_DEAD_ZONE;
+    in.p2Up = ball < s.p2Y + PADDLE_HEIGHT / 2 - BOT_DEAD_ZONE;
+    in.p2Down = ball > s.p2Y + PADDLE_HEIGHT / 2 + BOT_DEAD_ZONE;
+    in.serve = true;
+}
+
+template <typename Step>
+inline KernelBenchResult timeKernel(const GameConfig& cfg, unsigned long long ticks, Step step) {
+    MatchState s;
+    resetMatch(s, cfg);
+    MatchInput in;
+    unsigned long long checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long t = 0; t < ticks; t++) {
+        benchInput(s, in);
+        checksum += step(s, in);
+        if (matchOver(s, cfg)) {
+            s.p1Score = s.p2Score = 0;
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    KernelBenchResult result = { elapsed.count() / ticks, checksum };
+    return result;
+}
+
+const int BENCH_RUNS = 5;
+
+inline void runKernelBench(unsigned long long ticks) {
+    GameConfig cfg;
+    static volatile bool mode;
+
+    std::printf("Kernel benchmark, best of %d runs of %llu ticks\n", BENCH_RUNS, ticks);
+    for (int vsBot = 1; vsBot >= 0; vsBot--) {
+        mode = vsBot != 0;
+
+        // Alternate the two and keep the best of each to filter out noise.
+        KernelBenchResult specialized = {}, dispatched = {};
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            KernelBenchResult a = vsBot ?
+                timeKernel(cfg, ticks, [&cfg](MatchState& s, const MatchInput& in) { return stepMatch<true>(s, in, cfg); }) :
+                timeKernel(cfg, ticks, [&cfg](MatchState& s, const MatchInput& in) { return stepMatch<false>(s, in, cfg); });
+            KernelBenchResult b =
+                timeKernel(cfg, ticks, [&cfg](MatchState& s, const MatchInput& in) { return stepMatch(s, in, cfg, mode); });
+
+            if (run == 0 || a.nanosPerTick < specialized.nanosPerTick) specialized = a;
+            if (run == 0 || b.nanosPerTick < dispatched.nanosPerTick) dispatched = b;
+        }
+
+        std::printf("%-4s stepMatch<%s>: %6.2f ns/tick   runtime bool: %6.2f ns/tick   (%+.1f%%)%s\n",
+            vsBot ? "bot" : "pvp", vsBot ? "true" : "false",
+            specialized.nanosPerTick, dispatched.nanosPerTick,
+            100.0 * (dispatched.nanosPerTick - specialized.nanosPerTick) / specialized.nanosPerTick,
+            specialized.checksum == dispatched.checksum ? "" : "   MISMATCH");
+    }
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Every finished match is appended to an append-only history file, and
+// player ratings are updated incrementally from each result, so neither
+// loading nor querying ratings ever has to replay the history.
+
+struct MatchRecord {
+    std::string player1, player2;
+    int score1 = 0, score2 = 0;
+    bool vsBot = false;
+    float seconds = 0;
+};
+
+inline bool appendMatch(const std::string& path, const MatchRecord& match) {
+    std::ofstream file(path, std::ios::app);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << match.player1 << ' ' << match.player2 << ' '
+        << match.score1 << ' ' << match.score2 << ' '
+        << (match.vsBot ? "bot" : "pvp") << ' ' << match.seconds << '\n';
+    return true;
+}
+
+struct PlayerRating {
+    double rating = 1500;
+    int games = 0;
+    int wins = 0;
+};
+
+// Players ordered by (rating, name) in a treap whose nodes also count
+// their subtree, so inserts, removals, ranks and the k-th best player all
+// take O(log players), however many players share a rating.
+class RatingIndex {
+private:
+    typedef std::pair<double, std::string> Key;
+
+    struct Node {
+        Key key;
+        uint32_t priority;
+        int size;
+        int left, right;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_free;
+    int m_root = -1;
+    uint32_t m_seed = 2463534242u;
+
+    int size(int n) const { return n < 0 ? 0 : m_nodes[n].size; }
+
+    void resize(int n) {
+        m_nodes[n].size = 1 + size(m_nodes[n].left) + size(m_nodes[n].right);
+    }
+
+    uint32_t nextPriority() {
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 17;
+        m_seed ^= m_seed << 5;
+        return m_seed;
+    }
+
+    // Every key in a is below every key in b.
+    int merge(int a, int b) {
+        if (a < 0) return b;
+        if (b < 0) return a;
+        if (m_nodes[a].priority > m_nodes[b].priority) {
+            m_nodes[a].right = merge(m_nodes[a].right, b);
+            resize(a);
+            return a;
+        }
+        m_nodes[b].left = merge(a, m_nodes[b].left);
+        resize(b);
+        return b;
+    }
+
+    // Splits n into keys below key and keys at or above it.
+    void split(int n, const Key& key, int& below, int& rest) {
+        if (n < 0) {
+            below = rest = -1;
+            return;
+        }
+        if (m_nodes[n].key < key) {
+            int right;
+            split(m_nodes[n].right, key, right, rest);
+            m_nodes[n].right = right;
+            below = n;
+        }
+        else {
+            int left;
+            split(m_nodes[n].left, key, below, left);
+            m_nodes[n].left = left;
+            rest = n;
+        }
+        resize(n);
+    }
+
+    int erase(int n, const Key& key) {
+        if (n < 0) {
+            return n;
+        }
+        if (key < m_nodes[n].key) {
+            m_nodes[n].left = erase(m_nodes[n].left, key);
+        }
+        else if (m_nodes[n].key < key) {
+            m_nodes[n].right = erase(m_nodes[n].right, key);
+        }
+        else {
+            int joined = merge(m_nodes[n].left, m_nodes[n].right);
+            m_nodes[n].key.second.clear();
+            m_free.push_back(n);
+            return joined;
+        }
+        resize(n);
+        return n;
+    }
+
+public:
+    size_t size() const { return static_cast<size_t>(size(m_root)); }
+
+    void insert(double rating, const std::string& name) {
+        int n;
+        if (m_free.empty()) {
+            n = static_cast<int>(m_nodes.size());
+            m_nodes.push_back(Node());
+        }
+        else {
+            n = m_free.back();
+            m_free.pop_back();
+        }
+        Node& node = m_nodes[n];
+        node.key = Key(rating, name);
+        node.priority = nextPriority();
+        node.size = 1;
+        node.left = node.right = -1;
+
+        int below, rest;
+        split(m_root, m_nodes[n].key, below, rest);
+        m_root = merge(merge(below, n), rest);
+    }
+
+    void erase(double rating, const std::string& name) {
+        m_root = erase(m_root, Key(rating, name));
+    }
+
+    // Number of players ordered above (rating, name).
+    int countAbove(double rating, const std::string& name) const {
+        Key key(rating, name);
+        int above = 0;
+        for (int n = m_root; n >= 0;) {
+            if (key < m_nodes[n].key) {
+                above += 1 + size(m_nodes[n].right);
+                n = m_nodes[n].left;
+            }
+            else {
+                n = m_nodes[n].right;
+            }
+        }
+        return above;
+    }
+
+    // Name of the player with k players above them; k < size().
+    const std::string& nameAt(int k) const {
+        int n = m_root;
+        while (true) {
+            int above = size(m_nodes[n].right);
+            if (k < above) {
+                n = m_nodes[n].right;
+            }
+            else if (k == above) {
+                return m_nodes[n].key.second;
+            }
+            else {
+                k -= above + 1;
+                n = m_nodes[n].left;
+            }
+        }
+    }
+
+    void clear() {
+        m_nodes.clear();
+        m_free.clear();
+        m_root = -1;
+    }
+};
+
+// Elo ratings indexed by name, with a second index ordered by rating for
+// rank and top-N queries.
+//
+// The table is stored as a snapshot plus a journal next to it. Each result
+// appends the two players' new records to the journal, so saving costs the
+// same however many players there are; load() replays the journal and
+// folds it back into the snapshot.
+class RatingTable {
+private:
+    std::map<std::string, PlayerRating> m_players;
+    RatingIndex m_byRating;
+
+    static const int K_FACTOR = 32;
+
+    PlayerRating& player(const std::string& name) {
+        auto it = m_players.find(name);
+        if (it == m_players.end()) {
+            it = m_players.insert(std::make_pair(name, PlayerRating())).first;
+            m_byRating.insert(it->second.rating, name);
+        }
+        return it->second;
+    }
+
+    void setRating(const std::string& name, PlayerRating& p, double rating) {
+        m_byRating.erase(p.rating, name);
+        p.rating = rating;
+        m_byRating.insert(rating, name);
+    }
+
+    static std::string journalPath(const std::string& path) {
+        return path + ".journal";
+    }
+
+    static void writeRecord(std::ostream& out, const std::string& name, const PlayerRating& p) {
+        out.precision(12);
+        out << name << ' ' << p.rating << ' ' << p.games << ' ' << p.wins << '\n';
+    }
+
+    // Lines are "name rating games wins"; a later line for a name replaces
+    // an earlier one.
+    bool readRecords(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream iss(line);
+            std::string name;
+            PlayerRating p;
+
+            if (iss >> name >> p.rating >> p.games >> p.wins) {
+                auto it = m_players.find(name);
+                if (it == m_players.end()) {
+                    m_players[name] = p;
+                    m_byRating.insert(p.rating, name);
+                }
+                else {
+                    setRating(name, it->second, p.rating);
+                    it->second.games = p.games;
+                    it->second.wins = p.wins;
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    // Reads the snapshot and replays its journal. A non-empty journal is
+    // then compacted into a new snapshot, once, at load time.
+    bool load(const std::string& path) {
+        m_players.clear();
+        m_byRating.clear();
+
+        // Only the temporary file is left if save() stopped mid-rename.
+        bool found = readRecords(path) || readRecords(path + ".tmp");
+        std::ifstream journal(journalPath(path));
+        if (journal.is_open() && journal.peek() != std::ifstream::traits_type::eof()) {
+            journal.close();
+            readRecords(journalPath(path));
+            if (save(path)) {
+                std::ofstream(journalPath(path), std::ios::trunc);
+            }
+            found = true;
+        }
+        return found;
+    }
+
+    // Rewrites the whole snapshot. Cost grows with the number of players,
+    // so only load() calls it; use appendToJournal() after each result.
+    bool save(const std::string& path) const {
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream file(temporary);
+            if (!file.is_open()) {
+                return false;
+            }
+            for (const auto& entry : m_players) {
+                writeRecord(file, entry.first, entry.second);
+            }
+            if (!file) {
+                return false;
+            }
+        }
+
+        std::remove(path.c_str());
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+
+    // Appends the current records of the given players to the journal.
+    bool appendToJournal(const std::string& path, const std::string& first, const std::string& second) const {
+        std::ofstream file(journalPath(path), std::ios::app);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        const PlayerRating* a = find(first);
+        const PlayerRating* b = find(second);
+        if (a) writeRecord(file, first, *a);
+        if (b) writeRecord(file, second, *b);
+        return static_cast<bool>(file);
+    }
+
+    void recordResult(const std::string& winner, const std::string& loser) {
+        if (winner == loser) {
+            return;
+        }
+
+        PlayerRating& w = player(winner);
+        PlayerRating& l = player(loser);
+
+        double expected = 1.0 / (1.0 + std::pow(10.0, (l.rating - w.rating) / 400.0));
+        double change = K_FACTOR * (1.0 - expected);
+
+        setRating(winner, w, w.rating + change);
+        setRating(loser, l, l.rating - change);
+        w.games++;
+        w.wins++;
+        l.games++;
+    }
+
+    const PlayerRating* find(const std::string& name) const {
+        auto it = m_players.find(name);
+        return it == m_players.end() ? nullptr : &it->second;
+    }
+
+    size_t size() const { return m_players.size(); }
+
+    // 1-based position by rating, ties broken by name, or 0 for unknown
+    // players.
+    int rank(const std::string& name) const {
+        const PlayerRating* p = find(name);
+        return p ? m_byRating.countAbove(p->rating, name) + 1 : 0;
+    }
+
+    std::vector<std::pair<std::string, PlayerRating>> top(size_t count) const {
+        std::vector<std::pair<std::string, PlayerRating>> result;
+        for (size_t k = 0; k < count && k < m_byRating.size(); k++) {
+            const std::string& name = m_byRating.nameAt(static_cast<int>(k));
+            result.push_back(std::make_pair(name, m_players.at(name)));
+        }
+        return result;
+    }
+};
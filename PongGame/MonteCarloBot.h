@@ -0,0 +1,224 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PongRules.h"
+
+// Harder bot for player two. A pool of threads plays out random futures
+// of the match with the rules kernel for each candidate move (up, hold,
+// down) and scores them by who wins the point. Rollouts model player one
+// as a noisy ball tracker, so the search anticipates returns.
+//
+// think() never waits for the search: it publishes the current position,
+// gives the pool a time budget to search it, and returns the best move
+// from the results gathered so far. Results carry over between frames and
+// are halved each frame so stale positions fade out.
+//
+// The pool is started by start() when a hard-bot match begins. Between
+// budgets, and whenever think() is not being called, its threads block.
+
+enum BotMove { MoveUp, MoveHold, MoveDown, MoveCount };
+
+class MonteCarloBot {
+private:
+    static const int COMMIT_TICKS = 12;   // ticks the candidate move is held
+    static const int MAX_ROLLOUT_TICKS = 600;
+    static const int BATCH = 8;           // rollouts per merge into m_stats
+    static constexpr double MOVE_MARGIN = 0.05;
+
+    struct Root {
+        MatchState state;
+        GameConfig config;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    struct Stats {
+        double total[MoveCount];
+        double visits[MoveCount];
+    };
+
+    std::mutex m_mutex;                   // guards m_root, m_stats and m_running
+    std::condition_variable m_wake;       // new root published or shutting down
+    Root m_root;
+    Stats m_stats;
+    std::atomic<uint32_t> m_generation;
+    bool m_running;
+    std::vector<std::thread> m_workers;
+    std::chrono::microseconds m_budget;
+
+    struct Random {
+        uint32_t state;
+        uint32_t next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+        float unit() { return (next() & 0xFFFFFF) / float(0x1000000); }
+    };
+
+    // A paddle that follows the ball, aiming at a random point on itself.
+    static void track(bool& up, bool& down, float paddleY, float ballY, float aim) {
+        float target = paddleY + aim * PADDLE_HEIGHT;
+        up = ballY + BALL_RADIUS < target - BOT_DEAD_ZONE;
+        down = ballY + BALL_RADIUS > target + BOT_DEAD_ZONE;
+    }
+
+    // +1 if the bot wins the next point, -1 if it loses it, 0 if neither
+    // happens within the horizon.
+    static double rollout(MatchState s, const GameConfig& cfg, BotMove move, Random& rng) {
+        float aimP1 = 0.2f + 0.6f * rng.unit();
+        float aimP2 = 0.2f + 0.6f * rng.unit();
+
+        MatchInput in;
+        in.serve = true;
+        in.p2IsBot = true;
+
+        for (int t = 0; t < MAX_ROLLOUT_TICKS; t++) {
+            track(in.p1Up, in.p1Down, s.p1Y, s.ballY, aimP1);
+            if (t < COMMIT_TICKS) {
+                in.p2Up = move == MoveUp;
+                in.p2Down = move == MoveDown;
+            }
+            else {
+                track(in.p2Up, in.p2Down, s.p2Y, s.ballY, aimP2);
+            }
+
+            // Player one is a little slow to react.
+            if (rng.unit() < 0.3f) {
+                in.p1Up = in.p1Down = false;
+            }
+
+            unsigned events = stepMatch<false>(s, in, cfg);
+            if (events & ScoredP2) {
+                return 1;
+            }
+            if (events & ScoredP1) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    void workerLoop(uint32_t seed) {
+        Random rng = { seed * 2654435761u + 1 };
+        uint32_t searched = 0;
+
+        while (true) {
+            uint32_t generation;
+            Root root;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] {
+                    return !m_running || m_generation.load(std::memory_order_relaxed) != searched;
+                });
+                if (!m_running) {
+                    return;
+                }
+                generation = m_generation.load(std::memory_order_relaxed);
+                root = m_root;
+            }
+
+            while (std::chrono::steady_clock::now() < root.deadline &&
+                m_generation.load(std::memory_order_relaxed) == generation) {
+                Stats batch = {};
+                for (int i = 0; i < BATCH; i++) {
+                    BotMove move = static_cast<BotMove>(rng.next() % MoveCount);
+                    batch.total[move] += rollout(root.state, root.config, move, rng);
+                    batch.visits[move] += 1;
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (int m = 0; m < MoveCount; m++) {
+                    m_stats.total[m] += batch.total[m];
+                    m_stats.visits[m] += batch.visits[m];
+                }
+            }
+            searched = generation;
+        }
+    }
+
+public:
+    MonteCarloBot(std::chrono::microseconds budget = std::chrono::microseconds(2000))
+        : m_stats(), m_generation(0), m_running(true), m_budget(budget) {
+    }
+
+    ~MonteCarloBot() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_wake.notify_all();
+        for (std::thread& t : m_workers) {
+            t.join();
+        }
+    }
+
+    MonteCarloBot(const MonteCarloBot&) = delete;
+    MonteCarloBot& operator=(const MonteCarloBot&) = delete;
+
+    // Starts the pool on first use. Leaves a core for the game thread,
+    // which also steps the ticks.
+    void start() {
+        if (!m_workers.empty()) {
+            return;
+        }
+        unsigned cores = std::thread::hardware_concurrency();
+        unsigned threads = cores > 1 ? cores - 1 : 1;
+        for (unsigned i = 0; i < threads; i++) {
+            m_workers.push_back(std::thread(&MonteCarloBot::workerLoop, this, i + 1));
+        }
+    }
+
+    // Returns the best move found so far and starts searching the given
+    // position for the next call. Only holds the lock long enough to copy.
+    // Moving has to beat holding still by a margin, so noise in the
+    // estimates does not make the paddle jitter.
+    BotMove think(const MatchState& state, const GameConfig& config) {
+        BotMove best = MoveHold;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_stats.visits[MoveHold] > 0) {
+                double bestValue = m_stats.total[MoveHold] / m_stats.visits[MoveHold] + MOVE_MARGIN;
+                for (int m = 0; m < MoveCount; m++) {
+                    if (m != MoveHold && m_stats.visits[m] > 0 &&
+                        m_stats.total[m] / m_stats.visits[m] > bestValue) {
+                        bestValue = m_stats.total[m] / m_stats.visits[m];
+                        best = static_cast<BotMove>(m);
+                    }
+                }
+            }
+            else {
+                // Nothing searched yet; follow the ball.
+                bool up, down;
+                track(up, down, state.p2Y, state.ballY, 0.5f);
+                best = up ? MoveUp : (down ? MoveDown : MoveHold);
+            }
+
+            for (int m = 0; m < MoveCount; m++) {
+                m_stats.total[m] *= 0.5;
+                m_stats.visits[m] *= 0.5;
+            }
+
+            m_root.state = state;
+            m_root.config = config;
+            m_root.deadline = std::chrono::steady_clock::now() + m_budget;
+            m_generation.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_wake.notify_all();
+        return best;
+    }
+
+    // Forgets results from a previous match.
+    void reset() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats = Stats();
+    }
+};
@@ -7,10 +7,17 @@
      
 #include <SFML/Audio.hpp>
 
+#include "PongRules.h"
+#include "RallyLog.h"
+#include "KernelBench.h"
+#include "MatchHistory.h"
+#include "AllocTracker.h"
+#include "SimPipeline.h"
+#include "MonteCarloBot.h"
+
 using namespace std;
 
-enum GameState { Menu, InGame, WinScreen, HighScores };
-enum PlayState { ServePlayerOne, ServePlayerTwo, Playing };
+enum GameState { Menu, InGame, WinScreen, HighScores, Standings };
 enum ButtonState { UP, DOWN, HOVER };
 enum NameEntryState { NoEntry, EnteringP1Name, EnteringP2Name };
 
@@ -34,12 +41,17 @@ private:
     RectangleShapeData m_positionAndSize;
     sf::Color m_colorUp, m_colorDown, m_colorHover;
     ButtonState m_status;
+    sf::RectangleShape m_shape;
+    sf::Text m_label;
+    const sf::Font* m_labelFont = nullptr;
 
 public:
     Button(const string& text, const RectangleShapeData& posAndSize,
         sf::Color up, sf::Color down, sf::Color hover)
         : m_text(text), m_positionAndSize(posAndSize),
-        m_colorUp(up), m_colorDown(down), m_colorHover(hover), m_status(UP) {
+        m_colorUp(up), m_colorDown(down), m_colorHover(hover), m_status(UP),
+        m_shape(sf::Vector2f(posAndSize.width, posAndSize.height)) {
+        m_shape.setPosition(posAndSize.x, posAndSize.y);
     }
 
     bool HandleInput(Vector2D mousePos, bool mousePressed) {
@@ -59,19 +71,21 @@ public:
     }
 
     void Draw(sf::RenderWindow& window, sf::Font& font) {
-        sf::RectangleShape shape(sf::Vector2f(m_positionAndSize.width, m_positionAndSize.height));
-        shape.setPosition(m_positionAndSize.x, m_positionAndSize.y);
-        shape.setFillColor(m_status == DOWN ? m_colorDown : (m_status == HOVER ? m_colorHover : m_colorUp));
+        // The label is laid out once per font instead of every frame.
+        if (m_labelFont != &font) {
+            m_labelFont = &font;
+            m_label = sf::Text(m_text, font, 20);
+            m_label.setFillColor(sf::Color::White);
+            sf::FloatRect bounds = m_label.getLocalBounds();
+            m_label.setOrigin(bounds.width / 2, bounds.height / 2);
+            m_label.setPosition(m_positionAndSize.x + m_positionAndSize.width / 2,
+                m_positionAndSize.y + m_positionAndSize.height / 2);
+        }
 
-        sf::Text text(m_text, font, 20);
-        text.setFillColor(sf::Color::White);
-        sf::FloatRect bounds = text.getLocalBounds();
-        text.setOrigin(bounds.width / 2, bounds.height / 2);
-        text.setPosition(m_positionAndSize.x + m_positionAndSize.width / 2,
-            m_positionAndSize.y + m_positionAndSize.height / 2);
+        m_shape.setFillColor(m_status == DOWN ? m_colorDown : (m_status == HOVER ? m_colorHover : m_colorUp));
 
-        window.draw(shape);
-        window.draw(text);
+        window.draw(m_shape);
+        window.draw(m_label);
     }
 
     string getText() const { return m_text; }
@@ -80,11 +94,10 @@ public:
 class GameObject {
 public:
     virtual void draw(sf::RenderWindow& window) = 0;
-    virtual void update() {}
     virtual ~GameObject() {}
 };
 
-class Paddle : public GameObject {
+class Paddle final : public GameObject {
 public:
     sf::RectangleShape rect;
     Paddle(float x, float y, float width, float height, sf::Color color) {
@@ -96,25 +109,16 @@ public:
     void draw(sf::RenderWindow& window) override {
         window.draw(rect);
     }
-
-    void update() override {
-    }
 };
 
-class Ball : public GameObject {
+class Ball final : public GameObject {
 public:
     sf::CircleShape shape;
-    sf::Vector2f velocity;
 
     Ball(float radius) {
         shape.setRadius(radius);
         shape.setFillColor(sf::Color::White);
         shape.setPosition(400, 300);
-        velocity = sf::Vector2f(0, 0);
-    }
-
-    void update() override {
-        shape.move(velocity);
     }
 
     void draw(sf::RenderWindow& window) override {
@@ -124,35 +128,34 @@ public:
     void setPosition(float x, float y) {
         shape.setPosition(x, y);
     }
-
-    sf::FloatRect getBounds() const {
-        return shape.getGlobalBounds();
-    }
-
-    void reset() {
-        setPosition(400, 300);
-        velocity = sf::Vector2f(0, 0);
-    }
 };
 
 class Court {
+private:
+    sf::RectangleShape background;
+    sf::RectangleShape centerLine;
+    sf::CircleShape centerCircle;
+
 public:
-    void draw(sf::RenderWindow& window) {
-        sf::RectangleShape background(sf::Vector2f(800, 600));
+    Court() : centerCircle(60) {
         background.setFillColor(sf::Color::Black);
-        window.draw(background);
-
-        sf::RectangleShape centerLine(sf::Vector2f(2, 600));
         centerLine.setFillColor(sf::Color::White);
-        centerLine.setPosition(399, 0);
-        window.draw(centerLine);
-
-        sf::CircleShape centerCircle(60);
         centerCircle.setOrigin(60, 60);
-        centerCircle.setPosition(400, 300);
         centerCircle.setFillColor(sf::Color::Transparent);
         centerCircle.setOutlineThickness(2);
         centerCircle.setOutlineColor(sf::Color::White);
+    }
+
+    void setSize(float width, float height) {
+        background.setSize(sf::Vector2f(width, height));
+        centerLine.setSize(sf::Vector2f(2, height));
+        centerLine.setPosition(width / 2 - 1, 0);
+        centerCircle.setPosition(width / 2, height / 2);
+    }
+
+    void draw(sf::RenderWindow& window) {
+        window.draw(background);
+        window.draw(centerLine);
         window.draw(centerCircle);
     }
 };
@@ -162,6 +165,8 @@ private:
     sf::Text p1Text, p2Text;
     int* p1Score;
     int* p2Score;
+    int shownP1Score = -1, shownP2Score = -1;
+    bool rebuilt = false;
 
 public:
     ScoreBoard(sf::Font& font, int* s1, int* s2) : p1Score(s1), p2Score(s2) {
@@ -177,11 +182,24 @@ public:
     }
 
     void draw(sf::RenderWindow& window) {
-        p1Text.setString("P1: " + to_string(*p1Score));
-        p2Text.setString("P2: " + to_string(*p2Score));
+        // Only rebuild the strings when a score changes.
+        rebuilt = false;
+        if (*p1Score != shownP1Score) {
+            shownP1Score = *p1Score;
+            p1Text.setString("P1: " + to_string(shownP1Score));
+            rebuilt = true;
+        }
+        if (*p2Score != shownP2Score) {
+            shownP2Score = *p2Score;
+            p2Text.setString("P2: " + to_string(shownP2Score));
+            rebuilt = true;
+        }
         window.draw(p1Text);
         window.draw(p2Text);
     }
+
+    // True when the last draw() had to rebuild a score string.
+    bool rebuiltLastDraw() const { return rebuilt; }
 };
 
 class PlayerScore {
@@ -196,8 +214,10 @@ class PongMenu {
 
     
     Button botButton;
+    Button hardBotButton;
     Button pvpButton;
     Button highScoreButton;
+    Button standingsButton;
     Button quitButton;
 
     
@@ -205,10 +225,12 @@ class PongMenu {
 
 public:
     PongMenu()
-        : botButton("Player vs Bot", RectangleShapeData(300, 150, 200, 60), sf::Color(100, 100, 255), sf::Color::Blue, sf::Color(150, 150, 255)),
-        pvpButton("Player vs Player", RectangleShapeData(300, 230, 200, 60), sf::Color(255, 100, 100), sf::Color::Red, sf::Color(255, 150, 150)),
-        highScoreButton("High Scores", RectangleShapeData(300, 310, 200, 60), sf::Color(0, 200, 0), sf::Color::Green, sf::Color(100, 255, 100)),
-        quitButton("Quit", RectangleShapeData(300, 390, 200, 60), sf::Color(200, 200, 0), sf::Color::Yellow, sf::Color(255, 255, 100)) {
+        : botButton("Player vs Bot", RectangleShapeData(300, 130, 200, 60), sf::Color(100, 100, 255), sf::Color::Blue, sf::Color(150, 150, 255)),
+        hardBotButton("Player vs Hard Bot", RectangleShapeData(300, 200, 200, 60), sf::Color(60, 60, 200), sf::Color(0, 0, 150), sf::Color(120, 120, 230)),
+        pvpButton("Player vs Player", RectangleShapeData(300, 270, 200, 60), sf::Color(255, 100, 100), sf::Color::Red, sf::Color(255, 150, 150)),
+        highScoreButton("High Scores", RectangleShapeData(300, 340, 200, 60), sf::Color(0, 200, 0), sf::Color::Green, sf::Color(100, 255, 100)),
+        standingsButton("Standings", RectangleShapeData(300, 410, 200, 60), sf::Color(150, 0, 150), sf::Color::Magenta, sf::Color(220, 100, 220)),
+        quitButton("Quit", RectangleShapeData(300, 480, 200, 60), sf::Color(200, 200, 0), sf::Color::Yellow, sf::Color(255, 255, 100)) {
 
       
         titleText.setString("PONG GAME");
@@ -228,24 +250,36 @@ public:
 
         
         botButton.Draw(window, font);
+        hardBotButton.Draw(window, font);
         pvpButton.Draw(window, font);
         highScoreButton.Draw(window, font);
+        standingsButton.Draw(window, font);
         quitButton.Draw(window, font);
     }
 
 
-    void handle(Vector2D mousePos, bool clicked, GameState& state, bool& vsBot) {
+    void handle(Vector2D mousePos, bool clicked, GameState& state, bool& vsBot, bool& hardBot) {
         if (botButton.HandleInput(mousePos, clicked)) {
             state = InGame;
             vsBot = true;
+            hardBot = false;
+        }
+        if (hardBotButton.HandleInput(mousePos, clicked)) {
+            state = InGame;
+            vsBot = true;
+            hardBot = true;
         }
         if (pvpButton.HandleInput(mousePos, clicked)) {
             state = InGame;
             vsBot = false;
+            hardBot = false;
         }
         if (highScoreButton.HandleInput(mousePos, clicked)) {
             state = HighScores;
         }
+        if (standingsButton.HandleInput(mousePos, clicked)) {
+            state = Standings;
+        }
         if (quitButton.HandleInput(mousePos, clicked)) {
             exit(0);
         }
@@ -254,17 +288,21 @@ public:
 
 class PongGame {
 
+    ConfigWatcher config = ConfigWatcher("config.txt");
     GameState state = Menu;
-    PlayState playState = ServePlayerOne;
     NameEntryState nameEntryState = NoEntry;
     bool vsBot = false;
-    int p1Score = 0, p2Score = 0;
-    Paddle p1 = Paddle(50, 250, 10, 100, sf::Color::Red);
-    Paddle p2 = Paddle(740, 250, 10, 100, sf::Color::Blue);
-    Ball ball = Ball(10.f);
+    bool hardBot = false;
+    MatchState match;
+    SimPipeline simulation;
+    MonteCarloBot hardBotPlanner;
+    uint32_t tick = 0;
+    Paddle p1 = Paddle(PADDLE_MARGIN, 250, PADDLE_WIDTH, PADDLE_HEIGHT, sf::Color::Red);
+    Paddle p2 = Paddle(740, 250, PADDLE_WIDTH, PADDLE_HEIGHT, sf::Color::Blue);
+    Ball ball = Ball(BALL_RADIUS);
     Court court;
     sf::Font font;
-    ScoreBoard scoreboard = ScoreBoard(font, &p1Score, &p2Score);
+    ScoreBoard scoreboard = ScoreBoard(font, &match.p1Score, &match.p2Score);
     PongMenu menu;
     Vector2D mousePos;
     bool mouseClicked = false;
@@ -284,14 +322,16 @@ class PongGame {
     
     sf::Music menuMusic;
 
+    RallyLog rallyLog{ "rallies.bin" };
+
 
 
 
     Button continueButton;
     Button returnButton;
 
-    GameObject** gameObjects;
-    int gameObjectCount;
+    static const int GAME_OBJECT_COUNT = 3;
+    GameObject* gameObjects[GAME_OBJECT_COUNT];
 
     PlayerScore* highScores;
     int highScoreCount;
@@ -302,6 +342,15 @@ class PongGame {
     int highScoreTextCount;
     sf::Text backToMenuText;
 
+    static const int STANDINGS_SHOWN = 10;
+    RatingTable ratings;
+    sf::Text standingsTitle;
+    sf::Text standingsTexts[STANDINGS_SHOWN];
+    int standingsTextCount = 0;
+    sf::Text standingsRankText;
+    sf::Clock matchClock;
+    float matchSeconds = 0;
+
     string player1Name = "";
     string player2Name = "";
     string currentInputName = "";
@@ -330,13 +379,14 @@ public:
         winText.setCharacterSize(40);
         winText.setFillColor(sf::Color::White);
 
-        gameObjectCount = 3;
-        gameObjects = new GameObject * [gameObjectCount];
+        resetMatch(match, config.get());
+        court.setSize(config.get().courtWidth, config.get().courtHeight);
+
         gameObjects[0] = &p1;
         gameObjects[1] = &p2;
         gameObjects[2] = &ball;
 
-        highScoreCapacity = 10;
+        highScoreCapacity = config.get().leaderboardSize;
         highScores = new PlayerScore[highScoreCapacity];
         highScoreCount = 0;
 
@@ -344,6 +394,7 @@ public:
         highScoreTextCount = 0;
 
         initHighScores();
+        initStandings();
 
 
        
@@ -374,14 +425,13 @@ public:
     }
 
     ~PongGame() {
-        delete[] gameObjects;
         delete[] highScores;
         delete[] highScoreTexts;
         menuMusic.stop(); 
     }
     void resetScores() {
-        p1Score = 0;
-        p2Score = 0;
+        match.p1Score = 0;
+        match.p2Score = 0;
         
     }
 
@@ -394,9 +444,7 @@ public:
     }
 
     void resetBall(PlayState nextState) {
-        ball.setPosition(390, 300);
-        ball.velocity = { 0, 0 };
-        playState = nextState;
+        ::resetBall(match, config.get(), nextState);
     }
 
     void initHighScores() {
@@ -488,8 +536,6 @@ public:
 
     void updateHighScoreDisplay() {
         highScoreTextCount = highScoreCount;
-        delete[] highScoreTexts;
-        highScoreTexts = new sf::Text[highScoreCapacity];
 
         int height = 100;
         int space = 40;
@@ -532,14 +578,94 @@ public:
         updateHighScoreDisplay();
     }
 
+    void initStandings() {
+        standingsTitle.setFont(font);
+        standingsTitle.setString("STANDINGS");
+        standingsTitle.setCharacterSize(40);
+        standingsTitle.setFillColor(sf::Color::Magenta);
+        standingsTitle.setPosition(300, 50);
+
+        for (int i = 0; i < STANDINGS_SHOWN; i++) {
+            standingsTexts[i].setFont(font);
+            standingsTexts[i].setCharacterSize(24);
+            standingsTexts[i].setFillColor(sf::Color::White);
+            standingsTexts[i].setPosition(100, 100.f + i * 40);
+        }
+
+        standingsRankText.setFont(font);
+        standingsRankText.setCharacterSize(24);
+        standingsRankText.setFillColor(sf::Color::Yellow);
+        standingsRankText.setPosition(100, 500);
+
+        ratings.load("ratings.txt");
+        updateStandingsDisplay();
+    }
+
+    // Lists the top players and, when given, where another player stands.
+    void updateStandingsDisplay(const string& ratedPlayer = "") {
+        auto top = ratings.top(STANDINGS_SHOWN);
+        standingsTextCount = static_cast<int>(top.size());
+
+        for (int i = 0; i < standingsTextCount; i++) {
+            const PlayerRating& p = top[i].second;
+            stringstream ss;
+            ss << (i + 1) << ". " << top[i].first << " - " << static_cast<int>(p.rating + 0.5)
+                << "  (" << p.wins << "/" << p.games << " won)";
+            standingsTexts[i].setString(ss.str());
+        }
+
+        int rank = ratings.rank(ratedPlayer);
+        if (rank > 0) {
+            stringstream ss;
+            ss << ratedPlayer << " is ranked " << rank << " of " << ratings.size();
+            standingsRankText.setString(ss.str());
+        }
+    }
+
+    static string ratingName(const string& entered, const string& fallback) {
+        if (entered.empty()) {
+            return fallback;
+        }
+
+        string name = entered;
+        for (char& c : name) {
+            if (c == ' ') {
+                c = '_';
+            }
+        }
+        return name;
+    }
+
+    // Called once per finished match, after any name entry. The duration is
+    // taken when the match ends so name entry does not count towards it.
+    void recordMatch(float seconds) {
+        MatchRecord record;
+        record.player1 = ratingName(player1Name, "Player1");
+        record.player2 = vsBot ? (hardBot ? "HardBot" : "Bot") : ratingName(player2Name, "Player2");
+        record.score1 = match.p1Score;
+        record.score2 = match.p2Score;
+        record.vsBot = vsBot;
+        record.seconds = seconds;
+
+        if (!appendMatch("matches.txt", record)) {
+            cerr << "Failed to write match history!" << endl;
+        }
+
+        bool player1Win = record.score1 > record.score2;
+        ratings.recordResult(player1Win ? record.player1 : record.player2,
+            player1Win ? record.player2 : record.player1);
+        ratings.appendToJournal("ratings.txt", record.player1, record.player2);
+        updateStandingsDisplay(record.player1);
+    }
+
     void handleWin() {
       
         player1Name = "";
         player2Name = "";
         currentInputName = "";
 
-        bool player1Win = p1Score >= 10;
-        int winnerScore = player1Win ? p1Score : p2Score;
+        bool player1Win = match.p1Score >= config.get().winScore;
+        int winnerScore = player1Win ? match.p1Score : match.p2Score;
 
         if (isHighScore(winnerScore)) {
             if (vsBot) {
@@ -565,6 +691,9 @@ public:
                 currentNameText.setPosition(420, 280);
             }
         }
+        else {
+            recordMatch(matchSeconds);
+        }
     }
 
     void handleNameEntry(sf::Event event) {
@@ -574,7 +703,7 @@ public:
                     if (nameEntryState == EnteringP1Name) {
                         player1Name = currentInputName;
 
-                        if (!vsBot && p2Score >= 10) {
+                        if (!vsBot && match.p2Score >= config.get().winScore) {
                             
 
                             nameEntryState = EnteringP2Name;
@@ -582,7 +711,7 @@ public:
                             currentInputName = "";
                             currentNameText.setString("_");
                         }
-                        else if (!vsBot && p1Score >= 10) {
+                        else if (!vsBot && match.p1Score >= config.get().winScore) {
                             
 
                             nameEntryState = EnteringP2Name;
@@ -593,7 +722,8 @@ public:
                         else {
                             
 
-                            addHighScore(player1Name, p1Score);
+                            addHighScore(player1Name, match.p1Score);
+                            recordMatch(matchSeconds);
                             nameEntryState = NoEntry;
                             state = HighScores;
                         }
@@ -602,8 +732,9 @@ public:
                         player2Name = currentInputName;
 
                         
-                        addHighScore(player1Name, p1Score);
-                        addHighScore(player2Name, p2Score);
+                        addHighScore(player1Name, match.p1Score);
+                        addHighScore(player2Name, match.p2Score);
+                        recordMatch(matchSeconds);
 
                         nameEntryState = NoEntry;
                         state = HighScores;
@@ -636,15 +767,39 @@ public:
 
 
 
+    const GameConfig& getConfig() const {
+        return config.get();
+    }
+
+    // True from the first frame of a match until it is won. Frames in this
+    // state, serve waits included, should not touch the heap, except for
+    // the frames where the scoreboard text changes (see main()).
+    bool matchInProgress() const {
+        return state == InGame;
+    }
+
+    bool scoreboardRebuilt() const {
+        return scoreboard.rebuiltLastDraw();
+    }
+
     void update() {
+        finishTick();
+        config.poll();
+
         if (state == Menu) {
             if (menuMusic.getStatus() != sf::Music::Playing) {
                 startMenuMusic();
             }
-            menu.handle(mousePos, mouseClicked, state, vsBot);
+            menu.handle(mousePos, mouseClicked, state, vsBot, hardBot);
             if (state != Menu) {
                 stopMenuMusic();  
                 newGameStarting = true; 
+                if (state == InGame && hardBot) {
+                    hardBotPlanner.start();
+                }
+                if (state == InGame && config.get().pipelineTicks) {
+                    simulation.start();
+                }
             }
 
             mouseClicked = false;
@@ -654,6 +809,8 @@ public:
         
         if (newGameStarting && state == InGame) {
             resetScores();
+            hardBotPlanner.reset();
+            matchClock.restart();
             newGameStarting = false;
         }
 
@@ -666,6 +823,8 @@ public:
             if (continueButton.HandleInput(mousePos, mouseClicked)) {
                 resetScores();
                 resetBall(ServePlayerOne);
+                hardBotPlanner.reset();
+                matchClock.restart();
                 state = InGame;
             }
             if (returnButton.HandleInput(mousePos, mouseClicked)) {
@@ -676,88 +835,110 @@ public:
             return;
         }
 
-        if (state == HighScores) {
+        if (state == HighScores || state == Standings) {
             return;
         }
 
-        if ((playState == ServePlayerOne || playState == ServePlayerTwo) &&
-            sf::Keyboard::isKeyPressed(sf::Keyboard::Space)) {
-            ball.velocity = playState == ServePlayerOne ? sf::Vector2f(3, 3) : sf::Vector2f(-3, 3);
-            playState = Playing;
+        MatchInput input;
+        input.serve = sf::Keyboard::isKeyPressed(sf::Keyboard::Space);
+        input.p1Up = sf::Keyboard::isKeyPressed(sf::Keyboard::W);
+        input.p1Down = sf::Keyboard::isKeyPressed(sf::Keyboard::S);
+        input.p2Up = sf::Keyboard::isKeyPressed(sf::Keyboard::Up);
+        input.p2Down = sf::Keyboard::isKeyPressed(sf::Keyboard::Down);
+
+        // The hard bot steers player two through the PvP kernel, at the
+        // same speed as the easy bot.
+        if (vsBot && hardBot) {
+            BotMove move = hardBotPlanner.think(match, config.get());
+            input.p2Up = move == MoveUp;
+            input.p2Down = move == MoveDown;
+            input.p2IsBot = true;
         }
 
-        if (playState == Playing)
-            ball.update();
-
-        auto bounds = ball.getBounds();
-        if (bounds.top <= 0 || bounds.top + bounds.height >= 600) {
-            ball.velocity.y *= -1;
-            wallHitSound.play();  
+        // With pipelineTicks the tick runs on the simulation thread while
+        // this frame is drawn from the current state, and finishTick()
+        // picks it up next frame. That costs a frame of input latency, and
+        // a tick is far cheaper than the hand-off, so by default it runs
+        // here.
+        if (config.get().pipelineTicks) {
+            simulation.submit(match, input, config.snapshot(), vsBot && !hardBot);
+        }
+        else {
+            MatchContacts contacts;
+            unsigned events = stepMatch(match, input, config.get(), vsBot && !hardBot, &contacts);
+            applyTick(events, contacts);
         }
 
-        if (ball.getBounds().intersects(p1.rect.getGlobalBounds())) {
-            ball.velocity.x = abs(ball.velocity.x);
-            paddleHitSound.play();  
+        mouseClicked = false;
+    }
+
+    // Waits for a tick submitted to the pipeline last frame and makes it the
+    // current state. Runs before anything else in update() so the rest of
+    // the frame sees a settled match.
+    void finishTick() {
+        unsigned events;
+        MatchContacts contacts;
+        if (simulation.collect(match, events, contacts)) {
+            applyTick(events, contacts);
         }
+    }
 
-        if (ball.getBounds().intersects(p2.rect.getGlobalBounds())) {
-            ball.velocity.x = -abs(ball.velocity.x);
-            paddleHitSound.play(); 
+    // Sounds, telemetry and win check for a finished tick.
+    void applyTick(unsigned events, const MatchContacts& contacts) {
+        tick++;
+        if (events) {
+            logRallyEvents(events, contacts, config.get());
         }
 
-        if (bounds.left <= 0) {
-            p2Score++;
-            scoreSound.play();  
-            checkWin();
-            resetBall(ServePlayerOne);
+        if (events & WallHit) {
+            wallHitSound.play();
+        }
+        if (events & (PaddleHitP1 | PaddleHitP2)) {
+            paddleHitSound.play();
         }
-        else if (bounds.left + bounds.width >= 800) {
-            p1Score++;
-            scoreSound.play();  
+        if (events & (ScoredP1 | ScoredP2)) {
+            scoreSound.play();
             checkWin();
-            resetBall(ServePlayerTwo);
         }
+    }
 
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::W) && p1.rect.getPosition().y > 0)
-            p1.rect.move(0, -5);
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::S) &&
-            p1.rect.getPosition().y + p1.rect.getSize().y < 600)
-            p1.rect.move(0, 5);
-
-        if (vsBot)
-            botAI();
-        else {
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up) && p2.rect.getPosition().y > 0)
-                p2.rect.move(0, -5);
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down) &&
-                p2.rect.getPosition().y + p2.rect.getSize().y < 600)
-                p2.rect.move(0, 5);
+    // Positions come from the kernel's contacts: by now the paddles have
+    // moved and a scored ball is back at the centre.
+    void logRallyEvents(unsigned events, const MatchContacts& contacts, const GameConfig& cfg) {
+        if (events & Served) {
+            rallyLog.push(RallyServe, tick, match.ballVX > 0 ? 1 : 2);
+        }
+        if (events & PaddleHitP1) {
+            rallyLog.push(RallyPaddleHit, tick, 1, contacts.p1HitOffset);
+        }
+        if (events & PaddleHitP2) {
+            rallyLog.push(RallyPaddleHit, tick, 2, contacts.p2HitOffset);
+        }
+        if (events & WallHit) {
+            rallyLog.push(RallyWallHit, tick, contacts.wallX < cfg.courtWidth / 2 ? 1 : 2, contacts.wallX);
+        }
+        if (events & ScoredP1) {
+            rallyLog.push(RallyScore, tick, 1);
+        }
+        if (events & ScoredP2) {
+            rallyLog.push(RallyScore, tick, 2);
         }
-
-        mouseClicked = false;
     }
 
     void checkWin() {
-        if (p1Score >= 10 || p2Score >= 10) {
+        const GameConfig& cfg = config.get();
+        if (matchOver(match, cfg)) {
             victorySound.play();  
             state = WinScreen;
-            winText.setString(vsBot ? (p1Score >= 10 ? "Player wins!" : "Bot wins!") :
-                (p1Score >= 10 ? "Player 1 wins!" : "Player 2 wins!"));
-            winText.setPosition(400 - winText.getLocalBounds().width / 2, 200);
+            matchSeconds = matchClock.getElapsedTime().asSeconds();
+            winText.setString(vsBot ? (match.p1Score >= cfg.winScore ? "Player wins!" : "Bot wins!") :
+                (match.p1Score >= cfg.winScore ? "Player 1 wins!" : "Player 2 wins!"));
+            winText.setPosition(cfg.courtWidth / 2 - winText.getLocalBounds().width / 2, 200);
 
             handleWin();
         }
     }
 
-    void botAI() {
-        float ballY = ball.shape.getPosition().y;
-        float botY = p2.rect.getPosition().y + p2.rect.getSize().y / 2;
-        if (ballY < botY - 8)
-            p2.rect.move(0, -2);
-        else if (ballY > botY + 8)
-            p2.rect.move(0, 2);
-    }
-
     void draw(sf::RenderWindow& window) {
         window.clear();
 
@@ -790,12 +971,27 @@ public:
             return;
         }
 
+        if (state == Standings) {
+            window.draw(standingsTitle);
+            for (int i = 0; i < standingsTextCount; i++) {
+                window.draw(standingsTexts[i]);
+            }
+            window.draw(standingsRankText);
+            window.draw(backToMenuText);
+            return;
+        }
+
+        const GameConfig& cfg = config.get();
         court.draw(window);
-        for (int i = 0; i < gameObjectCount; i++)
+
+        p1.rect.setPosition(PADDLE_MARGIN, match.p1Y);
+        p2.rect.setPosition(paddleTwoX(cfg), match.p2Y);
+        ball.setPosition(match.ballX, match.ballY);
+        for (int i = 0; i < GAME_OBJECT_COUNT; i++)
             gameObjects[i]->draw(window);
         scoreboard.draw(window);
 
-        if (playState == ServePlayerOne || playState == ServePlayerTwo)
+        if (match.playState != Playing)
             window.draw(serveText);
     }
 
@@ -808,7 +1004,7 @@ public:
         if (state == WinScreen && nameEntryState != NoEntry) {
             handleHighScoreEvents(event);
         }
-        else if (state == HighScores) {
+        else if (state == HighScores || state == Standings) {
             if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
                 state = Menu;
             }
@@ -816,22 +1012,54 @@ public:
     }
 };
 
-int main() {
-    
-    sf::RenderWindow window(sf::VideoMode(800, 600), "Pong Game");
+int main(int argc, char* argv[]) {
+    if (argc == 3 && string(argv[1]) == "--rally-stats") {
+        return printRallyStats(argv[2]) ? 0 : 1;
+    }
+    if (argc >= 2 && string(argv[1]) == "--bench") {
+        unsigned long long ticks = argc >= 3 ? strtoull(argv[2], nullptr, 10) : 0;
+        runKernelBench(ticks > 0 ? ticks : 20000000ULL);
+        return 0;
+    }
+
+    AllocTracker::setGameThread();
+
     PongGame game;
+    const GameConfig& cfg = game.getConfig();
+    sf::RenderWindow window(sf::VideoMode(static_cast<unsigned>(cfg.courtWidth),
+        static_cast<unsigned>(cfg.courtHeight)), "Pong Game");
 
     while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-            game.handleEvent(event);
+        AllocTracker::beginFrame();
+        bool enforceNoAllocs = game.matchInProgress();
+
+        {
+            AllocScope scope(AllocEvents);
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed)
+                    window.close();
+                game.handleEvent(event);
+            }
+        }
+
+        {
+            AllocScope scope(AllocUpdate);
+            game.update();
+        }
+        {
+            AllocScope scope(AllocDraw);
+            game.draw(window);
+        }
+        {
+            AllocScope scope(AllocDisplay);
+            window.display();
         }
 
-        game.update();
-        game.draw(window);
-        window.display();
+        // Frames that start or end a match are not checked, nor frames where
+        // a point changes the scoreboard: formatting the new score into an
+        // sf::Text allocates, and it happens once per point.
+        AllocTracker::endFrame(enforceNoAllocs && game.matchInProgress() && !game.scoreboardRebuilt());
     }
 
     return 0;
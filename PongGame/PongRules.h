@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cmath>
+
+#include "GameConfig.h"
+
+// The playing-field simulation, kept free of SFML so it can be stepped
+// without a window. PongGame renders from a MatchState and turns the
+// returned events into sounds and win checks.
+
+enum PlayState { ServePlayerOne, ServePlayerTwo, Playing };
+
+// Bits returned by stepMatch() describing what happened during a tick.
+enum MatchEvent {
+    WallHit = 1 << 0,
+    PaddleHitP1 = 1 << 1,
+    PaddleHitP2 = 1 << 2,
+    ScoredP1 = 1 << 3,
+    ScoredP2 = 1 << 4,
+    Served = 1 << 5
+};
+
+const float PADDLE_WIDTH = 10;
+const float PADDLE_HEIGHT = 100;
+const float PADDLE_MARGIN = 50;
+const float BALL_RADIUS = 10;
+const float BOT_DEAD_ZONE = 8;
+
+struct MatchInput {
+    bool p1Up = false, p1Down = false;
+    bool p2Up = false, p2Down = false;
+    bool serve = false;
+    bool p2IsBot = false;   // p2Up/p2Down come from a bot, which moves at botSpeed
+};
+
+// Where the ball made contact during a tick, measured before anything
+// else moves. Only meaningful when the matching event bit is set.
+struct MatchContacts {
+    float p1HitOffset = 0, p2HitOffset = 0;   // ball centre minus paddle centre
+    float wallX = 0;                          // ball x at the wall bounce
+};
+
+// Ball and paddle positions are top-left corners, as in SFML.
+struct MatchState {
+    float ballX = 0, ballY = 0;
+    float ballVX = 0, ballVY = 0;
+    float p1Y = 0, p2Y = 0;
+    int p1Score = 0, p2Score = 0;
+    PlayState playState = ServePlayerOne;
+};
+
+inline float paddleTwoX(const GameConfig& cfg) {
+    return cfg.courtWidth - PADDLE_MARGIN - PADDLE_WIDTH;
+}
+
+inline void resetBall(MatchState& s, const GameConfig& cfg, PlayState nextState) {
+    s.ballX = cfg.courtWidth / 2 - BALL_RADIUS;
+    s.ballY = cfg.courtHeight / 2;
+    s.ballVX = 0;
+    s.ballVY = 0;
+    s.playState = nextState;
+}
+
+inline void resetMatch(MatchState& s, const GameConfig& cfg) {
+    s.p1Y = cfg.courtHeight / 2 - PADDLE_HEIGHT / 2;
+    s.p2Y = s.p1Y;
+    s.p1Score = 0;
+    s.p2Score = 0;
+    resetBall(s, cfg, ServePlayerOne);
+}
+
+// Same test as sf::FloatRect::intersects for the ball against a paddle.
+inline bool ballHitsPaddle(const MatchState& s, float paddleX, float paddleY) {
+    float size = 2 * BALL_RADIUS;
+    return std::fmax(s.ballX, paddleX) < std::fmin(s.ballX + size, paddleX + PADDLE_WIDTH) &&
+        std::fmax(s.ballY, paddleY) < std::fmin(s.ballY + size, paddleY + PADDLE_HEIGHT);
+}
+
+// One tick of play. The mode is a template parameter so each kernel is
+// compiled without the PvP/bot branch; use the overload below when the
+// mode is only known at run time. Pass contacts to learn where hits landed.
+template <bool VsBot>
+inline unsigned stepMatch(MatchState& s, const MatchInput& in, const GameConfig& cfg,
+    MatchContacts* contacts = nullptr) {
+    unsigned events = 0;
+    float size = 2 * BALL_RADIUS;
+
+    if (s.playState != Playing && in.serve) {
+        s.ballVX = s.playState == ServePlayerOne ? cfg.serveSpeedX : -cfg.serveSpeedX;
+        s.ballVY = cfg.serveSpeedY;
+        s.playState = Playing;
+        events |= Served;
+    }
+
+    if (s.playState == Playing) {
+        s.ballX += s.ballVX;
+        s.ballY += s.ballVY;
+    }
+
+    if (s.ballY <= 0 || s.ballY + size >= cfg.courtHeight) {
+        s.ballVY = -s.ballVY;
+        events |= WallHit;
+        if (contacts) contacts->wallX = s.ballX;
+    }
+
+    if (ballHitsPaddle(s, PADDLE_MARGIN, s.p1Y)) {
+        s.ballVX = std::fabs(s.ballVX);
+        events |= PaddleHitP1;
+        if (contacts) contacts->p1HitOffset = s.ballY + BALL_RADIUS - (s.p1Y + PADDLE_HEIGHT / 2);
+    }
+
+    if (ballHitsPaddle(s, paddleTwoX(cfg), s.p2Y)) {
+        s.ballVX = -std::fabs(s.ballVX);
+        events |= PaddleHitP2;
+        if (contacts) contacts->p2HitOffset = s.ballY + BALL_RADIUS - (s.p2Y + PADDLE_HEIGHT / 2);
+    }
+
+    if (s.ballX <= 0) {
+        s.p2Score++;
+        events |= ScoredP2;
+        resetBall(s, cfg, ServePlayerOne);
+    }
+    else if (s.ballX + size >= cfg.courtWidth) {
+        s.p1Score++;
+        events |= ScoredP1;
+        resetBall(s, cfg, ServePlayerTwo);
+    }
+
+    if (in.p1Up && s.p1Y > 0)
+        s.p1Y -= cfg.paddleSpeed;
+    if (in.p1Down && s.p1Y + PADDLE_HEIGHT < cfg.courtHeight)
+        s.p1Y += cfg.paddleSpeed;
+
+    if (VsBot) {
+        float botY = s.p2Y + PADDLE_HEIGHT / 2;
+        if (s.ballY < botY - BOT_DEAD_ZONE)
+            s.p2Y -= cfg.botSpeed;
+        else if (s.ballY > botY + BOT_DEAD_ZONE)
+            s.p2Y += cfg.botSpeed;
+    }
+    else {
+        float speed = in.p2IsBot ? cfg.botSpeed : cfg.paddleSpeed;
+        if (in.p2Up && s.p2Y > 0)
+            s.p2Y -= speed;
+        if (in.p2Down && s.p2Y + PADDLE_HEIGHT < cfg.courtHeight)
+            s.p2Y += speed;
+    }
+
+    return events;
+}
+
+inline bool matchOver(const MatchState& s, const GameConfig& cfg) {
+    return s.p1Score >= cfg.winScore || s.p2Score >= cfg.winScore;
+}
+
+inline unsigned stepMatch(MatchState& s, const MatchInput& in, const GameConfig& cfg, bool vsBot,
+    MatchContacts* contacts = nullptr) {
+    return vsBot ? stepMatch<true>(s, in, cfg, contacts) : stepMatch<false>(s, in, cfg, contacts);
+}
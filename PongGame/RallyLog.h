@@ -0,0 +1,247 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Rally telemetry. The game thread pushes small fixed-size events into a
+// single-producer/single-consumer ring; a writer thread drains it and
+// appends them to a binary file in column-major blocks:
+//
+//   uint32 magic, uint32 count,
+//   uint32 tick[count], uint8 type[count], uint8 side[count], float position[count]
+
+enum RallyEventType : uint8_t { RallyServe, RallyPaddleHit, RallyWallHit, RallyScore };
+
+struct RallyEvent {
+    uint32_t tick;
+    uint8_t type;
+    uint8_t side;     // 1 or 2: serving, hitting or scoring player; for a wall
+                      // hit, the player whose half of the court the ball was in
+    float position;   // paddle hit: ball centre minus paddle centre
+};
+
+const uint32_t RALLY_BLOCK_MAGIC = 0x314C5250; // "PRL1"
+
+class RallyLog {
+public:
+    static const size_t BLOCK_SIZE = 1024;  // most events in one block
+
+private:
+    static const size_t CAPACITY = 4096;   // power of two
+
+    RallyEvent m_ring[CAPACITY];
+    std::atomic<size_t> m_head;  // written by the game thread
+    std::atomic<size_t> m_tail;  // written by the writer thread
+    std::atomic<bool> m_running;
+    std::atomic<unsigned> m_dropped;
+
+    std::string m_path;
+    std::thread m_writer;
+
+    // Only touched by the writer thread.
+    uint32_t m_ticks[BLOCK_SIZE];
+    uint8_t m_types[BLOCK_SIZE];
+    uint8_t m_sides[BLOCK_SIZE];
+    float m_positions[BLOCK_SIZE];
+
+    size_t drainBlock() {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t head = m_head.load(std::memory_order_acquire);
+        size_t count = 0;
+
+        while (tail != head && count < BLOCK_SIZE) {
+            const RallyEvent& e = m_ring[tail & (CAPACITY - 1)];
+            m_ticks[count] = e.tick;
+            m_types[count] = e.type;
+            m_sides[count] = e.side;
+            m_positions[count] = e.position;
+            count++;
+            tail++;
+        }
+
+        m_tail.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    void writeBlock(std::ofstream& file, size_t count) {
+        uint32_t header[2] = { RALLY_BLOCK_MAGIC, static_cast<uint32_t>(count) };
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(m_ticks), count * sizeof(m_ticks[0]));
+        file.write(reinterpret_cast<const char*>(m_types), count * sizeof(m_types[0]));
+        file.write(reinterpret_cast<const char*>(m_sides), count * sizeof(m_sides[0]));
+        file.write(reinterpret_cast<const char*>(m_positions), count * sizeof(m_positions[0]));
+    }
+
+    void writerLoop() {
+        std::ofstream file(m_path, std::ios::binary | std::ios::app);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << m_path << std::endl;
+        }
+
+        bool running = true;
+        while (running) {
+            running = m_running.load(std::memory_order_acquire);
+
+            size_t count;
+            bool wrote = false;
+            while ((count = drainBlock()) > 0) {
+                if (file.is_open()) {
+                    writeBlock(file, count);
+                }
+                wrote = true;
+            }
+
+            // Flushing after every drain keeps the file usable when the
+            // game exits without running destructors.
+            if (wrote) {
+                file.flush();
+            }
+            if (running) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+    }
+
+public:
+    RallyLog(const std::string& path)
+        : m_head(0), m_tail(0), m_running(true), m_dropped(0), m_path(path) {
+        m_writer = std::thread(&RallyLog::writerLoop, this);
+    }
+
+    ~RallyLog() {
+        m_running.store(false, std::memory_order_release);
+        m_writer.join();
+        if (m_dropped.load() > 0) {
+            std::cerr << "Rally log dropped " << m_dropped.load() << " events" << std::endl;
+        }
+    }
+
+    RallyLog(const RallyLog&) = delete;
+    RallyLog& operator=(const RallyLog&) = delete;
+
+    // Game thread only. Never blocks; drops the event if the ring is full.
+    void push(RallyEventType type, uint32_t tick, uint8_t side, float position = 0) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == CAPACITY) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        RallyEvent& e = m_ring[head & (CAPACITY - 1)];
+        e.tick = tick;
+        e.type = type;
+        e.side = side;
+        e.position = position;
+        m_head.store(head + 1, std::memory_order_release);
+    }
+};
+
+// Reads a rally log and prints per-rally aggregates. A rally runs from a
+// serve to the next score; events outside a rally are ignored.
+inline bool printRallyStats(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+
+    unsigned long long rallies = 0, paddleHits = 0, wallHits = 0, rallyTicks = 0;
+    unsigned long long serves[2] = { 0, 0 }, points[2] = { 0, 0 };
+    double hitOffset = 0;
+    unsigned longestRally = 0;
+
+    bool inRally = false;
+    uint32_t serveTick = 0;
+    unsigned hitsThisRally = 0;
+
+    std::vector<uint32_t> ticks;
+    std::vector<uint8_t> types, sides;
+    std::vector<float> positions;
+
+    uint32_t header[2];
+    while (file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        if (header[0] != RALLY_BLOCK_MAGIC) {
+            std::cerr << "Corrupt block in " << path << std::endl;
+            return false;
+        }
+
+        // The writer never emits more than a block's worth, so anything
+        // larger is corruption and must not size the buffers.
+        size_t count = header[1];
+        if (count > RallyLog::BLOCK_SIZE) {
+            std::cerr << "Corrupt block in " << path << std::endl;
+            return false;
+        }
+        ticks.resize(count);
+        types.resize(count);
+        sides.resize(count);
+        positions.resize(count);
+        file.read(reinterpret_cast<char*>(ticks.data()), count * sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(types.data()), count);
+        file.read(reinterpret_cast<char*>(sides.data()), count);
+        file.read(reinterpret_cast<char*>(positions.data()), count * sizeof(float));
+        if (!file) {
+            std::cerr << "Truncated block in " << path << std::endl;
+            break;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            int side = sides[i] == 2 ? 1 : 0;
+            switch (types[i]) {
+            case RallyServe:
+                inRally = true;
+                serveTick = ticks[i];
+                hitsThisRally = 0;
+                serves[side]++;
+                break;
+            case RallyPaddleHit:
+                if (inRally) {
+                    paddleHits++;
+                    hitsThisRally++;
+                    hitOffset += std::fabs(positions[i]);
+                }
+                break;
+            case RallyWallHit:
+                if (inRally) {
+                    wallHits++;
+                }
+                break;
+            case RallyScore:
+                if (inRally) {
+                    rallies++;
+                    points[side]++;
+                    rallyTicks += ticks[i] - serveTick;
+                    if (hitsThisRally > longestRally) {
+                        longestRally = hitsThisRally;
+                    }
+                    inRally = false;
+                }
+                break;
+            }
+        }
+    }
+
+    if (rallies == 0) {
+        std::cout << "No complete rallies in " << path << std::endl;
+        return true;
+    }
+
+    std::printf("Rallies:              %llu\n", rallies);
+    std::printf("Serves P1 / P2:       %llu / %llu\n", serves[0], serves[1]);
+    std::printf("Points P1 / P2:       %llu / %llu\n", points[0], points[1]);
+    std::printf("Paddle hits / rally:  %.2f (longest %u)\n", double(paddleHits) / rallies, longestRally);
+    std::printf("Wall bounces / rally: %.2f\n", double(wallHits) / rallies);
+    std::printf("Ticks to score:       %.1f\n", double(rallyTicks) / rallies);
+    if (paddleHits > 0) {
+        std::printf("Mean hit offset:      %.1f px from paddle centre\n", hitOffset / paddleHits);
+    }
+    return true;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "PongRules.h"
+
+// Runs the rules kernel on a worker thread so the next tick is simulated
+// while the main thread renders the current one. The worker steps its own
+// copy of the match (the back buffer); the game keeps rendering its copy
+// (the front buffer) until collect() hands the new state over.
+//
+// Only one tick is ever in flight, and the main thread must collect it
+// before submitting the next. The hand-off uses a mutex and condition
+// variable rather than atomics alone: the project builds as C++14, which
+// has no atomic wait, and the worker must sleep instead of spinning while
+// no match is being played.
+//
+// A tick of the current kernel costs well under a microsecond, less than
+// the hand-off itself (about 5-15 us), so the game only pipelines when
+// pipelineTicks is set. Those timings come from a single-core machine,
+// where the worker and the game thread share one core; on several cores
+// the hand-off is cheaper, but still costs more than the tick it moves.
+//
+// The worker thread is only started by start() or the first submit().
+class SimPipeline {
+private:
+    struct Tick {
+        MatchState state;
+        MatchInput input;
+        std::shared_ptr<const GameConfig> config;
+        bool vsBot = false;
+        unsigned events = 0;
+        MatchContacts contacts;
+    };
+
+    Tick m_tick;
+    std::mutex m_mutex;                 // guards the flags below
+    std::condition_variable m_wake;     // work submitted or shutting down
+    std::condition_variable m_done;     // tick finished
+    bool m_pending;
+    bool m_finished;
+    bool m_running;
+    std::thread m_worker;
+    bool m_inFlight;  // main thread only
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this] { return m_pending || !m_running; });
+            if (!m_pending) {
+                return;
+            }
+            m_pending = false;
+
+            // m_tick is not touched by the main thread until m_finished.
+            lock.unlock();
+            m_tick.events = stepMatch(m_tick.state, m_tick.input, *m_tick.config, m_tick.vsBot, &m_tick.contacts);
+            lock.lock();
+
+            m_finished = true;
+            m_done.notify_one();
+        }
+    }
+
+public:
+    SimPipeline() : m_pending(false), m_finished(false), m_running(true), m_inFlight(false) {
+    }
+
+    ~SimPipeline() {
+        if (!m_worker.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_wake.notify_one();
+        m_worker.join();
+    }
+
+    SimPipeline(const SimPipeline&) = delete;
+    SimPipeline& operator=(const SimPipeline&) = delete;
+
+    // Starts the worker on first use. Call it outside a match frame when
+    // possible, since creating the thread allocates.
+    void start() {
+        if (!m_worker.joinable()) {
+            m_worker = std::thread(&SimPipeline::workerLoop, this);
+        }
+    }
+
+    // Starts stepping a copy of state on the worker. The config snapshot is
+    // kept alive until the tick is collected.
+    void submit(const MatchState& state, const MatchInput& input,
+        std::shared_ptr<const GameConfig> config, bool vsBot) {
+        start();
+        m_tick.state = state;
+        m_tick.input = input;
+        m_tick.config = std::move(config);
+        m_tick.vsBot = vsBot;
+        m_inFlight = true;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending = true;
+            m_finished = false;
+        }
+        m_wake.notify_one();
+    }
+
+    // Waits for the tick in flight and copies out its result. Returns false
+    // when nothing was submitted.
+    bool collect(MatchState& state, unsigned& events, MatchContacts& contacts) {
+        if (!m_inFlight) {
+            return false;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [this] { return m_finished; });
+        }
+
+        state = m_tick.state;
+        events = m_tick.events;
+        contacts = m_tick.contacts;
+        m_tick.config.reset();
+        m_inFlight = false;
+        return true;
+    }
+};
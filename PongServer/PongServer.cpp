@@ -0,0 +1,727 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET Socket;
+#define poll WSAPoll
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int Socket;
+const Socket INVALID_SOCKET = -1;
+#define closesocket close
+#endif
+
+#include "PongRules.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Dedicated server: many matches in one process, stepped by the same rules
+// kernel as the game. One UDP socket serves every player; a front-end loop
+// handles joins and input, and worker threads each step a fixed share of
+// the match table at the tick rate.
+
+// ---------------------------------------------------------------------------
+// Wire format. Both ends run on the same machine or architecture, so fields
+// are sent in host byte order.
+
+enum PacketType : uint8_t { PacketJoin, PacketJoined, PacketInput, PacketState, PacketEnd };
+
+enum InputButtons : uint8_t { ButtonUp = 1, ButtonDown = 2, ButtonServe = 4 };
+
+#pragma pack(push, 1)
+struct JoinPacket {
+    uint8_t type;
+    uint8_t vsBot;
+    uint32_t token;    // chosen by the client, echoed back in JoinedPacket
+};
+
+struct JoinedPacket {
+    uint8_t type;
+    uint8_t slot;
+    uint32_t token;
+    uint32_t matchId;
+};
+
+struct InputPacket {
+    uint8_t type;
+    uint8_t slot;
+    uint8_t buttons;
+    uint32_t token;
+    uint32_t matchId;
+};
+
+// State and end packets carry the recipient's token so a client hosting
+// many players can route them without a lookup.
+struct StatePacket {
+    uint8_t type;
+    uint8_t playState;
+    uint8_t p1Score, p2Score;
+    uint32_t token;
+    uint32_t matchId;
+    uint32_t tick;
+    uint32_t events;
+    float ballX, ballY;
+    float p1Y, p2Y;
+};
+
+struct EndPacket {
+    uint8_t type;
+    uint8_t p1Score, p2Score;
+    uint32_t token;
+    uint32_t matchId;
+};
+#pragma pack(pop)
+
+// ---------------------------------------------------------------------------
+// Match table
+
+enum SlotStatus : uint8_t { SlotFree, SlotReserved, SlotWaiting, SlotActive };
+
+// One entry per match, preallocated. The front end owns a slot while it is
+// Reserved or Waiting; the worker for that slot owns it while it is Active
+// and hands it back by storing Free.
+struct ServerMatch {
+    atomic<uint8_t> status;
+    atomic<uint8_t> buttons[2];
+    atomic<uint8_t> heard;    // set by the front end on any input
+    bool vsBot;
+    uint32_t tick;
+    uint32_t idleTicks;
+    uint32_t tokens[2];
+    sockaddr_in players[2];
+    MatchState state;
+};
+
+// A player is identified by its address and the token it joined with.
+struct PlayerKey {
+    uint32_t address;
+    uint16_t port;
+    uint32_t token;
+
+    bool operator==(const PlayerKey& other) const {
+        return address == other.address && port == other.port && token == other.token;
+    }
+};
+
+struct PlayerKeyHash {
+    size_t operator()(const PlayerKey& key) const {
+        uint64_t h = (uint64_t(key.address) << 32 | key.token) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 29) ^ key.port);
+    }
+};
+
+struct PlayerSeat {
+    uint32_t matchId;
+    uint8_t slot;
+};
+
+struct WorkerMetrics {
+    atomic<uint64_t> ticks;
+    atomic<uint64_t> lagMicros;
+    atomic<uint64_t> maxLagMicros;
+    atomic<uint64_t> stepNanos;
+    atomic<uint64_t> matchTicks;
+};
+
+class PongServer {
+private:
+    Socket m_socket;
+    GameConfig m_config;
+    int m_tickRate;
+    size_t m_capacity;
+    unique_ptr<ServerMatch[]> m_matches;
+    vector<thread> m_workers;
+    unique_ptr<WorkerMetrics[]> m_metrics;
+    atomic<bool> m_running;
+    long long m_waitingPvp;   // front end only
+    steady_clock::time_point m_waitingHeard;   // front end only
+    size_t m_nextFree;        // front end only
+    unordered_map<PlayerKey, PlayerSeat, PlayerKeyHash> m_seats;   // front end only
+
+    static const int IDLE_SECONDS = 10;
+
+    void send(const sockaddr_in& to, const void* data, size_t size) {
+        sendto(m_socket, reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+            reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+    }
+
+    long long reserveSlot() {
+        for (size_t n = 0; n < m_capacity; n++) {
+            size_t i = (m_nextFree + n) % m_capacity;
+            uint8_t expected = SlotFree;
+            if (m_matches[i].status.compare_exchange_strong(expected, SlotReserved)) {
+                m_nextFree = i + 1;
+                return static_cast<long long>(i);
+            }
+        }
+        return -1;
+    }
+
+    static PlayerKey playerKey(const sockaddr_in& address, uint32_t token) {
+        PlayerKey key = { address.sin_addr.s_addr, address.sin_port, token };
+        return key;
+    }
+
+    // True while the seat still belongs to the player: its match has not
+    // ended and the slot has not been handed to someone else.
+    bool seatHeld(const PlayerKey& key, const PlayerSeat& seat) const {
+        const ServerMatch& m = m_matches[seat.matchId];
+        uint8_t status = m.status.load(memory_order_acquire);
+        if (status == SlotActive || (status == SlotWaiting && seat.slot == 0)) {
+            const sockaddr_in& player = m.players[seat.slot];
+            return m.tokens[seat.slot] == key.token && player.sin_addr.s_addr == key.address &&
+                player.sin_port == key.port;
+        }
+        return false;
+    }
+
+    void handleJoin(const JoinPacket& join, const sockaddr_in& from) {
+        PlayerKey key = playerKey(from, join.token);
+
+        // A repeated join means the reply was lost. Answer it again instead
+        // of starting a second match or pairing the player with itself.
+        auto seated = m_seats.find(key);
+        if (seated != m_seats.end()) {
+            if (seatHeld(key, seated->second)) {
+                if (seated->second.matchId == m_waitingPvp) {
+                    m_waitingHeard = steady_clock::now();
+                }
+                JoinedPacket reply = { PacketJoined, seated->second.slot, join.token, seated->second.matchId };
+                send(from, &reply, sizeof(reply));
+                return;
+            }
+            m_seats.erase(seated);
+        }
+
+        long long id;
+        uint8_t slot;
+
+        if (!join.vsBot && m_waitingPvp >= 0) {
+            id = m_waitingPvp;
+            slot = 1;
+            m_waitingPvp = -1;
+        }
+        else {
+            id = reserveSlot();
+            if (id < 0) {
+                return;   // full; the client retries
+            }
+            slot = 0;
+
+            ServerMatch& m = m_matches[id];
+            m.vsBot = join.vsBot != 0;
+            m.tick = 0;
+            m.idleTicks = 0;
+            m.heard.store(0, memory_order_relaxed);
+            m.buttons[0].store(0, memory_order_relaxed);
+            m.buttons[1].store(0, memory_order_relaxed);
+            resetMatch(m.state, m_config);
+        }
+
+        ServerMatch& m = m_matches[id];
+        m.tokens[slot] = join.token;
+        m.players[slot] = from;
+
+        if (m.vsBot || slot == 1) {
+            m.status.store(SlotActive, memory_order_release);
+        }
+        else {
+            m.status.store(SlotWaiting, memory_order_release);
+            m_waitingPvp = id;
+            m_waitingHeard = steady_clock::now();
+        }
+
+        PlayerSeat seat = { static_cast<uint32_t>(id), slot };
+        m_seats[key] = seat;
+
+        JoinedPacket reply = { PacketJoined, slot, join.token, static_cast<uint32_t>(id) };
+        send(from, &reply, sizeof(reply));
+    }
+
+    void handleInput(const InputPacket& input) {
+        if (input.matchId >= m_capacity || input.slot > 1) {
+            return;
+        }
+
+        ServerMatch& m = m_matches[input.matchId];
+        uint8_t status = m.status.load(memory_order_acquire);
+        if (m.tokens[input.slot] != input.token) {
+            return;
+        }
+
+        // Input from the player waiting for an opponent keeps the slot open.
+        if (status == SlotWaiting && input.slot == 0 && input.matchId == m_waitingPvp) {
+            m_waitingHeard = steady_clock::now();
+            return;
+        }
+        if (status != SlotActive) {
+            return;
+        }
+        m.buttons[input.slot].store(input.buttons, memory_order_relaxed);
+        m.heard.store(1, memory_order_relaxed);
+    }
+
+    void stepMatchSlot(ServerMatch& m, uint32_t id) {
+        uint8_t b1 = m.buttons[0].load(memory_order_relaxed);
+        uint8_t b2 = m.buttons[1].load(memory_order_relaxed);
+
+        MatchInput in;
+        in.p1Up = (b1 & ButtonUp) != 0;
+        in.p1Down = (b1 & ButtonDown) != 0;
+        in.p2Up = (b2 & ButtonUp) != 0;
+        in.p2Down = (b2 & ButtonDown) != 0;
+        in.serve = ((b1 | b2) & ButtonServe) != 0;
+
+        unsigned events = stepMatch(m.state, in, m_config, m.vsBot);
+        m.tick++;
+
+        // Matches nobody has sent input to for a while are abandoned.
+        if (m.heard.exchange(0, memory_order_relaxed)) {
+            m.idleTicks = 0;
+        }
+        bool abandoned = ++m.idleTicks > static_cast<uint32_t>(m_tickRate * IDLE_SECONDS);
+
+        int players = m.vsBot ? 1 : 2;
+        if (matchOver(m.state, m_config) || abandoned) {
+            EndPacket end = { PacketEnd, static_cast<uint8_t>(m.state.p1Score),
+                static_cast<uint8_t>(m.state.p2Score), 0, id };
+            for (int p = 0; p < players; p++) {
+                end.token = m.tokens[p];
+                send(m.players[p], &end, sizeof(end));
+            }
+            m.status.store(SlotFree, memory_order_release);
+            return;
+        }
+
+        StatePacket state = { PacketState, static_cast<uint8_t>(m.state.playState),
+            static_cast<uint8_t>(m.state.p1Score), static_cast<uint8_t>(m.state.p2Score),
+            0, id, m.tick, events, m.state.ballX, m.state.ballY, m.state.p1Y, m.state.p2Y };
+        for (int p = 0; p < players; p++) {
+            state.token = m.tokens[p];
+            send(m.players[p], &state, sizeof(state));
+        }
+    }
+
+    // Steps every active match whose index is congruent to index modulo the
+    // worker count, once per tick, and records how late each tick started.
+    void workerLoop(size_t index) {
+        size_t stride = m_workers.size();
+        WorkerMetrics& metrics = m_metrics[index];
+        auto period = duration_cast<steady_clock::duration>(duration<double>(1.0 / m_tickRate));
+        auto next = steady_clock::now() + period;
+
+        while (m_running.load(memory_order_relaxed)) {
+            this_thread::sleep_until(next);
+
+            auto start = steady_clock::now();
+            uint64_t lag = duration_cast<microseconds>(start - next).count();
+            next += period;
+            if (start - next > period * 5) {
+                next = start + period;   // too far behind; drop the backlog
+            }
+
+            uint64_t stepped = 0;
+            for (size_t i = index; i < m_capacity; i += stride) {
+                ServerMatch& m = m_matches[i];
+                if (m.status.load(memory_order_acquire) == SlotActive) {
+                    stepMatchSlot(m, static_cast<uint32_t>(i));
+                    stepped++;
+                }
+            }
+
+            metrics.ticks.fetch_add(1, memory_order_relaxed);
+            metrics.lagMicros.fetch_add(lag, memory_order_relaxed);
+            // Compare-and-swap so a reset by printMetrics() is never
+            // overwritten with a maximum from the previous window.
+            uint64_t maxLag = metrics.maxLagMicros.load(memory_order_relaxed);
+            while (lag > maxLag &&
+                !metrics.maxLagMicros.compare_exchange_weak(maxLag, lag, memory_order_relaxed)) {
+            }
+            metrics.matchTicks.fetch_add(stepped, memory_order_relaxed);
+            metrics.stepNanos.fetch_add(duration_cast<nanoseconds>(steady_clock::now() - start).count(),
+                memory_order_relaxed);
+        }
+    }
+
+    void printMetrics(double seconds) {
+        uint64_t ticks = 0, lag = 0, maxLag = 0, nanos = 0, matchTicks = 0;
+        for (size_t i = 0; i < m_workers.size(); i++) {
+            WorkerMetrics& w = m_metrics[i];
+            ticks += w.ticks.exchange(0);
+            lag += w.lagMicros.exchange(0);
+            maxLag = max<uint64_t>(maxLag, w.maxLagMicros.exchange(0));
+            nanos += w.stepNanos.exchange(0);
+            matchTicks += w.matchTicks.exchange(0);
+        }
+
+        size_t active = 0;
+        for (size_t i = 0; i < m_capacity; i++) {
+            active += m_matches[i].status.load(memory_order_relaxed) == SlotActive;
+        }
+
+        printf("matches %zu | match ticks/s %.0f | tick lag avg %.2f ms max %.2f ms | cpu/match tick %.0f ns\n",
+            active, matchTicks / seconds,
+            ticks ? lag / 1000.0 / ticks : 0.0, maxLag / 1000.0,
+            matchTicks ? double(nanos) / matchTicks : 0.0);
+        fflush(stdout);
+    }
+
+public:
+    PongServer(Socket socket, const GameConfig& config, size_t capacity, size_t workers, int tickRate)
+        : m_socket(socket), m_config(config), m_tickRate(tickRate), m_capacity(capacity),
+        m_matches(new ServerMatch[capacity]), m_metrics(new WorkerMetrics[workers]),
+        m_running(true), m_waitingPvp(-1), m_nextFree(0) {
+        for (size_t i = 0; i < capacity; i++) {
+            m_matches[i].status.store(SlotFree, memory_order_relaxed);
+        }
+        for (size_t i = 0; i < workers; i++) {
+            m_metrics[i].ticks = 0;
+            m_metrics[i].lagMicros = 0;
+            m_metrics[i].maxLagMicros = 0;
+            m_metrics[i].stepNanos = 0;
+            m_metrics[i].matchTicks = 0;
+        }
+        m_workers.resize(workers);
+        for (size_t i = 0; i < workers; i++) {
+            m_workers[i] = thread(&PongServer::workerLoop, this, i);
+        }
+    }
+
+    ~PongServer() {
+        m_running.store(false);
+        for (thread& t : m_workers) {
+            t.join();
+        }
+    }
+
+    // Frees the PvP slot if its player has gone quiet while waiting for an
+    // opponent, so the next joiner is not paired with a client that left.
+    void expireWaiting(steady_clock::time_point now) {
+        if (m_waitingPvp < 0 || duration<double>(now - m_waitingHeard).count() < IDLE_SECONDS) {
+            return;
+        }
+
+        ServerMatch& m = m_matches[m_waitingPvp];
+        EndPacket end = { PacketEnd, 0, 0, m.tokens[0], static_cast<uint32_t>(m_waitingPvp) };
+        send(m.players[0], &end, sizeof(end));
+        m.status.store(SlotFree, memory_order_release);
+        m_waitingPvp = -1;
+    }
+
+    // Drops seats whose matches have ended.
+    void pruneSeats() {
+        for (auto it = m_seats.begin(); it != m_seats.end();) {
+            if (seatHeld(it->first, it->second)) {
+                ++it;
+            }
+            else {
+                it = m_seats.erase(it);
+            }
+        }
+    }
+
+    // Front end: waits for datagrams and dispatches them, printing metrics
+    // every few seconds. Never returns.
+    void run() {
+        pollfd pfd;
+        pfd.fd = m_socket;
+        pfd.events = POLLIN;
+
+        char buffer[512];
+        auto lastReport = steady_clock::now();
+
+        while (true) {
+            int ready = poll(&pfd, 1, 100);
+
+            while (ready > 0) {
+                sockaddr_in from;
+                socklen_t fromLength = sizeof(from);
+                int size = recvfrom(m_socket, buffer, sizeof(buffer), 0,
+                    reinterpret_cast<sockaddr*>(&from), &fromLength);
+                if (size <= 0) {
+                    break;
+                }
+
+                if (buffer[0] == PacketInput && size == sizeof(InputPacket)) {
+                    InputPacket input;
+                    memcpy(&input, buffer, sizeof(input));
+                    handleInput(input);
+                }
+                else if (buffer[0] == PacketJoin && size == sizeof(JoinPacket)) {
+                    JoinPacket join;
+                    memcpy(&join, buffer, sizeof(join));
+                    handleJoin(join, from);
+                }
+
+                // Drain whatever else is queued before polling again.
+                pfd.revents = 0;
+                ready = poll(&pfd, 1, 0);
+            }
+
+            auto now = steady_clock::now();
+            expireWaiting(now);
+
+            double elapsed = duration<double>(now - lastReport).count();
+            if (elapsed >= 5) {
+                printMetrics(elapsed);
+                pruneSeats();
+                lastReport = now;
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Load generator: simulates many players from one socket over loopback.
+// Even tokens play PvP, odd tokens play the bot. Each player follows the
+// ball with its paddle and always serves.
+
+struct SimulatedPlayer {
+    bool joined = false;
+    uint8_t slot = 0;
+    uint32_t matchId = 0;
+    float ballY = 0, paddleY = 0;
+    steady_clock::time_point joinSent;
+};
+
+static void sendJoin(Socket socket, const sockaddr_in& server, SimulatedPlayer& player, uint32_t token) {
+    JoinPacket join = { PacketJoin, static_cast<uint8_t>(token % 2), token };
+    sendto(socket, reinterpret_cast<const char*>(&join), sizeof(join), 0,
+        reinterpret_cast<const sockaddr*>(&server), sizeof(server));
+    player.joined = false;
+    player.joinSent = steady_clock::now();
+}
+
+static int runLoadGenerator(Socket socket, const sockaddr_in& server, size_t playerCount, int seconds, int tickRate) {
+    vector<SimulatedPlayer> players(playerCount);
+    for (size_t i = 0; i < playerCount; i++) {
+        sendJoin(socket, server, players[i], static_cast<uint32_t>(i));
+    }
+
+    pollfd pfd;
+    pfd.fd = socket;
+    pfd.events = POLLIN;
+
+    char buffer[512];
+    auto period = duration_cast<steady_clock::duration>(duration<double>(1.0 / tickRate));
+    auto start = steady_clock::now();
+    auto nextInput = start;
+    auto lastReport = start;
+    uint64_t states = 0, ends = 0;
+
+    while (steady_clock::now() - start < seconds * 1s) {
+        if (poll(&pfd, 1, 1) > 0) {
+            while (true) {
+                int size = recv(socket, buffer, sizeof(buffer), 0);
+                if (size <= 0) {
+                    break;
+                }
+
+                if (buffer[0] == PacketState && size == sizeof(StatePacket)) {
+                    StatePacket state;
+                    memcpy(&state, buffer, sizeof(state));
+                    states++;
+                    if (state.token < playerCount) {
+                        SimulatedPlayer& p = players[state.token];
+                        p.ballY = state.ballY;
+                        p.paddleY = p.slot == 0 ? state.p1Y : state.p2Y;
+                    }
+                }
+                else if (buffer[0] == PacketJoined && size == sizeof(JoinedPacket)) {
+                    JoinedPacket joined;
+                    memcpy(&joined, buffer, sizeof(joined));
+                    if (joined.token < playerCount) {
+                        SimulatedPlayer& p = players[joined.token];
+                        p.joined = true;
+                        p.slot = joined.slot;
+                        p.matchId = joined.matchId;
+                    }
+                }
+                else if (buffer[0] == PacketEnd && size == sizeof(EndPacket)) {
+                    EndPacket end;
+                    memcpy(&end, buffer, sizeof(end));
+                    if (end.token < playerCount && players[end.token].joined) {
+                        ends++;
+                        sendJoin(socket, server, players[end.token], end.token);
+                    }
+                }
+
+                pfd.revents = 0;
+                if (poll(&pfd, 1, 0) <= 0) {
+                    break;
+                }
+            }
+        }
+
+        auto now = steady_clock::now();
+        if (now >= nextInput) {
+            nextInput += period;
+            size_t joined = 0;
+            for (size_t i = 0; i < playerCount; i++) {
+                SimulatedPlayer& p = players[i];
+                if (!p.joined) {
+                    if (now - p.joinSent > 1s) {
+                        sendJoin(socket, server, p, static_cast<uint32_t>(i));
+                    }
+                    continue;
+                }
+                joined++;
+
+                float paddleCenter = p.paddleY + PADDLE_HEIGHT / 2;
+                uint8_t buttons = ButtonServe;
+                if (p.ballY < paddleCenter - BOT_DEAD_ZONE)
+                    buttons |= ButtonUp;
+                else if (p.ballY > paddleCenter + BOT_DEAD_ZONE)
+                    buttons |= ButtonDown;
+
+                InputPacket input = { PacketInput, p.slot, buttons, static_cast<uint32_t>(i), p.matchId };
+                sendto(socket, reinterpret_cast<const char*>(&input), sizeof(input), 0,
+                    reinterpret_cast<const sockaddr*>(&server), sizeof(server));
+            }
+
+            double elapsed = duration<double>(now - lastReport).count();
+            if (elapsed >= 1) {
+                printf("players joined %zu/%zu | states/s %.0f | matches finished %llu\n",
+                    joined, playerCount, states / elapsed, static_cast<unsigned long long>(ends));
+                fflush(stdout);
+                states = 0;
+                lastReport = now;
+            }
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+
+const size_t MAX_MATCHES = 1 << 20;
+const size_t MAX_WORKERS = 256;
+
+// Accepts only a whole, non-negative decimal number that fits in an int.
+static bool parseCount(const char* text, int& value) {
+    char* end;
+    errno = 0;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < 0 || parsed > INT32_MAX) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+static void printUsage() {
+    cerr << "Usage: PongServer [--port N] [--matches N] [--workers N] [--tick-rate N]\n"
+        << "       PongServer --load PLAYERS [--port N] [--seconds N] [--tick-rate N]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int port = 5555;
+    size_t matches = 8192;
+    size_t workers = max(1u, thread::hardware_concurrency());
+    int tickRate = 60;
+    size_t loadPlayers = 0;
+    int seconds = 30;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        int value;
+        if (!parseCount(argv[++i], value)) {
+            printUsage();
+            return 1;
+        }
+        if (arg == "--port") port = value;
+        else if (arg == "--matches") matches = value;
+        else if (arg == "--workers") workers = value;
+        else if (arg == "--tick-rate") tickRate = value;
+        else if (arg == "--load") loadPlayers = value;
+        else if (arg == "--seconds") seconds = value;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (matches == 0 || matches > MAX_MATCHES || workers == 0 || workers > MAX_WORKERS ||
+        tickRate <= 0 || tickRate > 1000 || port <= 0 || port > 65535 || seconds <= 0) {
+        printUsage();
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        cerr << "Failed to start Winsock!" << endl;
+        return 1;
+    }
+#endif
+
+    Socket sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET) {
+        cerr << "Failed to create socket!" << endl;
+        return 1;
+    }
+
+    int bufferSize = 8 << 20;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+    setsockopt(sock, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (loadPlayers > 0) {
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int result = runLoadGenerator(sock, address, loadPlayers, seconds, tickRate);
+        closesocket(sock);
+        return result;
+    }
+
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (::bind(sock, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        cerr << "Failed to bind port " << port << "!" << endl;
+        closesocket(sock);
+        return 1;
+    }
+
+    GameConfig config;
+    if (!config.loadFromFile("config.txt")) {
+        cerr << "Failed to load config.txt, using defaults" << endl;
+    }
+    else if (!config.validate()) {
+        cerr << "Invalid config.txt, using defaults" << endl;
+        config = GameConfig();
+    }
+
+    cout << "Serving up to " << matches << " matches on UDP port " << port
+        << " with " << workers << " workers at " << tickRate << " ticks/s" << endl;
+
+    PongServer server(sock, config, matches, workers, tickRate);
+    server.run();
+    return 0;
+}